@@ -3,6 +3,10 @@
 
 #include <string>
 #include <vector>
+#include <memory>
+#include "value.h"
+
+struct InlinedCallNode;
 
 struct ASTNode {
     virtual ~ASTNode() {}
@@ -10,8 +14,8 @@ struct ASTNode {
 
 // Number
 struct NumberNode : ASTNode {
-    double value;
-    NumberNode(double v) : value(v) {}
+    Value value;
+    NumberNode(Value v) : value(v) {}
 };
 
 // Identifier (variable name)
@@ -74,7 +78,14 @@ struct ForNode : ASTNode {
 struct FuncDefNode : ASTNode {
     std::string name;
     std::vector<std::string> params;
-    ASTNode* body;
+    ASTNode* body; // nullptr until parsed when the body was pre-parsed
+    // Source range of a pre-parsed body, '{' through '}'
+    std::shared_ptr<const std::string> source;
+    size_t bodyBegin = 0;
+    size_t bodyEnd = 0;
+    bool optimized = false; // inlining pass already ran over body
+    std::vector<InlinedCallNode*> inlineSites; // call sites the pass wrapped in body
+    std::string parseError; // set if parsing the pre-parsed body failed
     FuncDefNode(const std::string& n, const std::vector<std::string>& p, ASTNode* b) : name(n), params(p), body(b) {}
 };
 
@@ -85,6 +96,19 @@ struct FuncCallNode : ASTNode {
     FuncCallNode(const std::string& n, const std::vector<ASTNode*>& a) : name(n), args(a) {}
 };
 
+// Call site that may get the callee's body inlined (see inliner.h).
+// Decided when it first runs; evaluates the original call when not
+// inlined or once the callee is redefined.
+struct InlinedCallNode : ASTNode {
+    FuncCallNode* call;
+    bool decided = false;
+    FuncDefNode* callee = nullptr;   // nullptr if not inlined or deoptimized
+    std::vector<std::string> locals; // fresh names bound to the arguments
+    ASTNode* body = nullptr;         // callee body with params renamed to locals
+    bool catchesReturn = false;      // body still has a 'return' that throws
+    InlinedCallNode(FuncCallNode* c) : call(c) {}
+};
+
 // Return
 struct ReturnNode : ASTNode {
     ASTNode* value; // may be nullptr
@@ -1,7 +1,8 @@
 #include "environment.h"
+#include "inliner.h"
 #include <stdexcept>
 
-void Environment::setVariable(const std::string& name, double value) {
+void Environment::setVariable(const std::string& name, Value value) {
     // If variable exists in current scope, overwrite; otherwise create in current scope.
     Environment* env = this;
     // search up to see if exists
@@ -14,7 +15,7 @@ void Environment::setVariable(const std::string& name, double value) {
     else this->variables[name] = value;
 }
 
-double Environment::getVariable(const std::string& name) {
+Value Environment::getVariable(const std::string& name) {
     Environment* env = this;
     while (env) {
         auto it = env->variables.find(name);
@@ -25,7 +26,16 @@ double Environment::getVariable(const std::string& name) {
 }
 
 void Environment::setFunction(const std::string& name, FuncDefNode* func) {
+    auto it = functions.find(name);
+    bool replaced = it != functions.end() && it->second != func;
+    bool redefined = parent != nullptr || replaced;
+    // the old body's call sites would otherwise stay registered for good
+    if (replaced) {
+        releaseCalls(it->second->inlineSites);
+        it->second->inlineSites.clear();
+    }
     functions[name] = func;
+    if (redefined) deoptimizeCalls(name);
 }
 
 FuncDefNode* Environment::getFunction(const std::string& name) {
@@ -37,3 +47,9 @@ FuncDefNode* Environment::getFunction(const std::string& name) {
     }
     throw std::runtime_error("Function not defined: " + name);
 }
+
+Environment* Environment::root() {
+    Environment* env = this;
+    while (env->parent) env = env->parent;
+    return env;
+}
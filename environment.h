@@ -4,19 +4,21 @@
 #include <unordered_map>
 #include <string>
 #include "ast.h"
+#include "value.h"
 
 class Environment {
 public:
-    std::unordered_map<std::string, double> variables;
+    std::unordered_map<std::string, Value> variables;
     std::unordered_map<std::string, FuncDefNode*> functions;
     Environment* parent = nullptr;
 
     Environment(Environment* p = nullptr) : parent(p) {}
 
-    void setVariable(const std::string& name, double value);
-    double getVariable(const std::string& name);
+    void setVariable(const std::string& name, Value value);
+    Value getVariable(const std::string& name);
     void setFunction(const std::string& name, FuncDefNode* func);
     FuncDefNode* getFunction(const std::string& name);
+    Environment* root();
 };
 
 #endif
@@ -1,11 +1,21 @@
 #include "evaluator.h"
+#include "parser.h"
+#include "inliner.h"
 #include <stdexcept>
-#include <cmath>
 #include <typeinfo>
 #include <iostream>
 
-double evaluate(ASTNode* node, Environment* env) {
-    if (!node) return 0;
+// Removes an inlined call's locals from the caller's scope when the call
+// is done, including when it exits through a ReturnException.
+struct InlinedLocals {
+    Environment* env;
+    const std::vector<std::string>& names;
+    InlinedLocals(Environment* e, const std::vector<std::string>& n) : env(e), names(n) {}
+    ~InlinedLocals() { for (auto& name : names) env->variables.erase(name); }
+};
+
+Value evaluate(ASTNode* node, Environment* env) {
+    if (!node) return Value();
 
     // Number
     if (auto n = dynamic_cast<NumberNode*>(node)) return n->value;
@@ -17,25 +27,25 @@ double evaluate(ASTNode* node, Environment* env) {
 
     // Binary op
     if (auto b = dynamic_cast<BinaryOpNode*>(node)) {
-        double L = evaluate(b->left, env);
-        double R = evaluate(b->right, env);
+        Value L = evaluate(b->left, env);
+        Value R = evaluate(b->right, env);
         const std::string &op = b->op;
         if (op == "+") return L + R;
         if (op == "-") return L - R;
         if (op == "*") return L * R;
         if (op == "/") return L / R;
-        if (op == "==") return (L == R) ? 1.0 : 0.0;
-        if (op == "!=") return (L != R) ? 1.0 : 0.0;
-        if (op == "<") return (L < R) ? 1.0 : 0.0;
-        if (op == ">") return (L > R) ? 1.0 : 0.0;
-        if (op == "<=") return (L <= R) ? 1.0 : 0.0;
-        if (op == ">=") return (L >= R) ? 1.0 : 0.0;
+        if (op == "==") return Value::fromInt(L == R);
+        if (op == "!=") return Value::fromInt(L != R);
+        if (op == "<") return Value::fromInt(L < R);
+        if (op == ">") return Value::fromInt(L > R);
+        if (op == "<=") return Value::fromInt(L <= R);
+        if (op == ">=") return Value::fromInt(L >= R);
         throw std::runtime_error("Unknown binary operator: " + op);
     }
 
     // Assignment
     if (auto a = dynamic_cast<AssignNode*>(node)) {
-        double val = evaluate(a->value, env);
+        Value val = evaluate(a->value, env);
         env->setVariable(a->name, val);
         return val;
     }
@@ -47,7 +57,7 @@ double evaluate(ASTNode* node, Environment* env) {
 
     // Block
     if (auto blk = dynamic_cast<BlockNode*>(node)) {
-        double last = 0;
+        Value last;
         for (auto stmt : blk->statements) {
             last = evaluate(stmt, env);
         }
@@ -56,16 +66,16 @@ double evaluate(ASTNode* node, Environment* env) {
 
     // If
     if (auto iff = dynamic_cast<IfNode*>(node)) {
-        double cond = evaluate(iff->condition, env);
-        if (cond != 0.0) return evaluate(iff->thenBlock, env);
+        Value cond = evaluate(iff->condition, env);
+        if (cond.isTruthy()) return evaluate(iff->thenBlock, env);
         if (iff->elseBlock) return evaluate(iff->elseBlock, env);
-        return 0;
+        return Value();
     }
 
     // While
     if (auto wh = dynamic_cast<WhileNode*>(node)) {
-        double last = 0;
-        while (evaluate(wh->condition, env) != 0.0) {
+        Value last;
+        while (evaluate(wh->condition, env).isTruthy()) {
             last = evaluate(wh->body, env);
         }
         return last;
@@ -73,12 +83,12 @@ double evaluate(ASTNode* node, Environment* env) {
 
     // For
     if (auto fr = dynamic_cast<ForNode*>(node)) {
-        double last = 0;
+        Value last;
         if (fr->init) evaluate(fr->init, env);
         while (true) {
             if (fr->condition) {
-                double c = evaluate(fr->condition, env);
-                if (c == 0.0) break;
+                Value c = evaluate(fr->condition, env);
+                if (!c.isTruthy()) break;
             }
             last = evaluate(fr->body, env);
             if (fr->update) evaluate(fr->update, env);
@@ -90,7 +100,7 @@ double evaluate(ASTNode* node, Environment* env) {
     // Function definition
     if (auto fd = dynamic_cast<FuncDefNode*>(node)) {
         env->setFunction(fd->name, fd);
-        return 0;
+        return Value();
     }
 
     // Function call
@@ -98,34 +108,57 @@ double evaluate(ASTNode* node, Environment* env) {
         // Look for builtin 'print' (simple)
         if (fc->name == "print") {
             for (size_t i = 0; i < fc->args.size(); ++i) {
-                double v = evaluate(fc->args[i], env);
+                Value v = evaluate(fc->args[i], env);
                 if (i) std::cout << " ";
-                if (std::floor(v) == v) std::cout << (long long)v; else std::cout << v;
+                std::cout << v;
             }
             std::cout << std::endl;
-            return 0;
+            return Value();
         }
 
         FuncDefNode* func = env->getFunction(fc->name);
         if (func->params.size() != fc->args.size()) throw std::runtime_error("wrong number of args in call to " + fc->name);
+        ASTNode* body = Parser::parseFuncBody(func);
+        if (!func->optimized) {
+            func->optimized = true;
+            body = func->body = inlineCalls(body, &func->inlineSites);
+        }
 
+        // params always live in the callee's scope, even if the caller has the same name
         Environment local(env);
         for (size_t i = 0; i < fc->args.size(); ++i) {
-            double a = evaluate(fc->args[i], env);
-            local.setVariable(func->params[i], a);
+            Value a = evaluate(fc->args[i], env);
+            local.variables[func->params[i]] = a;
         }
 
         try {
-            double r = evaluate(func->body, &local);
+            Value r = evaluate(body, &local);
             return r;
         } catch (ReturnException &re) {
             return re.value;
         }
     }
 
+    // Inlined call
+    if (auto ic = dynamic_cast<InlinedCallNode*>(node)) {
+        if (!ic->decided) decideInline(ic, env);
+        if (!ic->callee) return evaluate(ic->call, env);
+        InlinedLocals guard(env, ic->locals);
+        for (size_t i = 0; i < ic->locals.size(); ++i) {
+            Value a = evaluate(ic->call->args[i], env);
+            env->variables[ic->locals[i]] = a;
+        }
+        if (!ic->catchesReturn) return evaluate(ic->body, env);
+        try {
+            return evaluate(ic->body, env);
+        } catch (ReturnException &re) {
+            return re.value;
+        }
+    }
+
     // Return
     if (auto ret = dynamic_cast<ReturnNode*>(node)) {
-        double v = 0;
+        Value v;
         if (ret->value) v = evaluate(ret->value, env);
         throw ReturnException(v);
     }
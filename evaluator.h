@@ -3,13 +3,14 @@
 
 #include "ast.h"
 #include "environment.h"
+#include "value.h"
 #include <exception>
 
 struct ReturnException {
-    double value;
-    ReturnException(double v) : value(v) {}
+    Value value;
+    ReturnException(Value v) : value(v) {}
 };
 
-double evaluate(ASTNode* node, Environment* env);
+Value evaluate(ASTNode* node, Environment* env);
 
 #endif
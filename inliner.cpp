@@ -0,0 +1,298 @@
+#include "inliner.h"
+#include "parser.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <exception>
+
+// Max number of AST nodes in a body that will be inlined
+static const int InlineMaxCost = 24;
+
+typedef std::unordered_map<std::string, std::string> Renames;
+
+// Inlined call sites per callee, and names that must not be inlined
+static std::unordered_map<std::string, std::unordered_set<InlinedCallNode*>> inlinedCalls;
+static std::unordered_set<std::string> redefinedFunctions;
+
+// Node count of body, or -1 if it can't be inlined: any call other than
+// print, nested function definitions, or assignment to a non-param (that
+// would create the variable in the caller's scope instead of the callee's).
+static int inlineCost(ASTNode* node, const std::vector<std::string>& params) {
+    if (!node) return 0;
+    if (dynamic_cast<NumberNode*>(node) || dynamic_cast<IdentifierNode*>(node)) return 1;
+    if (auto b = dynamic_cast<BinaryOpNode*>(node)) {
+        int l = inlineCost(b->left, params), r = inlineCost(b->right, params);
+        return (l < 0 || r < 0) ? -1 : 1 + l + r;
+    }
+    if (auto a = dynamic_cast<AssignNode*>(node)) {
+        bool isParam = false;
+        for (auto& p : params) if (p == a->name) isParam = true;
+        int v = inlineCost(a->value, params);
+        return (!isParam || v < 0) ? -1 : 1 + v;
+    }
+    if (auto es = dynamic_cast<ExprStmtNode*>(node)) {
+        int e = inlineCost(es->expr, params);
+        return e < 0 ? -1 : e;
+    }
+    if (auto blk = dynamic_cast<BlockNode*>(node)) {
+        int cost = 1;
+        for (auto stmt : blk->statements) {
+            int c = inlineCost(stmt, params);
+            if (c < 0) return -1;
+            cost += c;
+        }
+        return cost;
+    }
+    if (auto iff = dynamic_cast<IfNode*>(node)) {
+        int c = inlineCost(iff->condition, params), t = inlineCost(iff->thenBlock, params), e = inlineCost(iff->elseBlock, params);
+        return (c < 0 || t < 0 || e < 0) ? -1 : 1 + c + t + e;
+    }
+    if (auto wh = dynamic_cast<WhileNode*>(node)) {
+        int c = inlineCost(wh->condition, params), b = inlineCost(wh->body, params);
+        return (c < 0 || b < 0) ? -1 : 1 + c + b;
+    }
+    if (auto fr = dynamic_cast<ForNode*>(node)) {
+        int i = inlineCost(fr->init, params), c = inlineCost(fr->condition, params);
+        int u = inlineCost(fr->update, params), b = inlineCost(fr->body, params);
+        return (i < 0 || c < 0 || u < 0 || b < 0) ? -1 : 1 + i + c + u + b;
+    }
+    if (auto fc = dynamic_cast<FuncCallNode*>(node)) {
+        if (fc->name != "print") return -1;
+        int cost = 1;
+        for (auto arg : fc->args) {
+            int c = inlineCost(arg, params);
+            if (c < 0) return -1;
+            cost += c;
+        }
+        return cost;
+    }
+    if (auto ret = dynamic_cast<ReturnNode*>(node)) {
+        int v = inlineCost(ret->value, params);
+        return v < 0 ? -1 : 1 + v;
+    }
+    return -1;
+}
+
+static std::string rename(const std::string& name, const Renames& renames) {
+    auto it = renames.find(name);
+    return it != renames.end() ? it->second : name;
+}
+
+// Copy of a body accepted by inlineCost, with params renamed
+static ASTNode* cloneRenamed(ASTNode* node, const Renames& renames) {
+    if (!node) return nullptr;
+    if (auto n = dynamic_cast<NumberNode*>(node)) return new NumberNode(n->value);
+    if (auto id = dynamic_cast<IdentifierNode*>(node)) return new IdentifierNode(rename(id->name, renames));
+    if (auto b = dynamic_cast<BinaryOpNode*>(node))
+        return new BinaryOpNode(b->op, cloneRenamed(b->left, renames), cloneRenamed(b->right, renames));
+    if (auto a = dynamic_cast<AssignNode*>(node))
+        return new AssignNode(rename(a->name, renames), cloneRenamed(a->value, renames));
+    if (auto es = dynamic_cast<ExprStmtNode*>(node)) return new ExprStmtNode(cloneRenamed(es->expr, renames));
+    if (auto blk = dynamic_cast<BlockNode*>(node)) {
+        BlockNode* copy = new BlockNode();
+        for (auto stmt : blk->statements) copy->statements.push_back(cloneRenamed(stmt, renames));
+        return copy;
+    }
+    if (auto iff = dynamic_cast<IfNode*>(node))
+        return new IfNode(cloneRenamed(iff->condition, renames), cloneRenamed(iff->thenBlock, renames),
+                          cloneRenamed(iff->elseBlock, renames));
+    if (auto wh = dynamic_cast<WhileNode*>(node))
+        return new WhileNode(cloneRenamed(wh->condition, renames), cloneRenamed(wh->body, renames));
+    if (auto fr = dynamic_cast<ForNode*>(node))
+        return new ForNode(cloneRenamed(fr->init, renames), cloneRenamed(fr->condition, renames),
+                           cloneRenamed(fr->update, renames), cloneRenamed(fr->body, renames));
+    if (auto fc = dynamic_cast<FuncCallNode*>(node)) {
+        std::vector<ASTNode*> args;
+        for (auto arg : fc->args) args.push_back(cloneRenamed(arg, renames));
+        return new FuncCallNode(fc->name, args);
+    }
+    if (auto ret = dynamic_cast<ReturnNode*>(node)) return new ReturnNode(cloneRenamed(ret->value, renames));
+    return nullptr;
+}
+
+static bool hasReturn(ASTNode* node) {
+    if (!node) return false;
+    if (dynamic_cast<ReturnNode*>(node)) return true;
+    if (auto blk = dynamic_cast<BlockNode*>(node)) {
+        for (auto stmt : blk->statements) if (hasReturn(stmt)) return true;
+        return false;
+    }
+    if (auto iff = dynamic_cast<IfNode*>(node)) return hasReturn(iff->thenBlock) || hasReturn(iff->elseBlock);
+    if (auto wh = dynamic_cast<WhileNode*>(node)) return hasReturn(wh->body);
+    if (auto fr = dynamic_cast<ForNode*>(node)) return hasReturn(fr->body);
+    return false;
+}
+
+// Statements of node with nested blocks spliced in (blocks don't open a scope).
+// An empty block evaluates to 0, so it's kept as a 0 statement.
+static void flatten(ASTNode* node, std::vector<ASTNode*>& out) {
+    if (!node) return;
+    if (auto blk = dynamic_cast<BlockNode*>(node)) {
+        if (blk->statements.empty()) out.push_back(new ExprStmtNode(new NumberNode(Value())));
+        for (auto stmt : blk->statements) flatten(stmt, out);
+        return;
+    }
+    out.push_back(node);
+}
+
+// Rewrite stmts so each 'return e' ends its path and becomes e, the
+// value of the block. Statements after an 'if' that returns move into both
+// of its branches. nullptr if a return sits inside a loop.
+static BlockNode* lowerReturns(const std::vector<ASTNode*>& stmts) {
+    BlockNode* out = new BlockNode();
+    for (size_t i = 0; i < stmts.size(); ++i) {
+        ASTNode* stmt = stmts[i];
+        if (!hasReturn(stmt)) {
+            out->statements.push_back(stmt);
+            continue;
+        }
+        if (auto ret = dynamic_cast<ReturnNode*>(stmt)) {
+            out->statements.push_back(new ExprStmtNode(ret->value ? ret->value : new NumberNode(Value())));
+            return out;
+        }
+        auto iff = dynamic_cast<IfNode*>(stmt);
+        if (!iff) {
+            delete out;
+            return nullptr;
+        }
+        std::vector<ASTNode*> thenStmts, elseStmts;
+        flatten(iff->thenBlock, thenStmts);
+        flatten(iff->elseBlock, elseStmts);
+        thenStmts.insert(thenStmts.end(), stmts.begin() + i + 1, stmts.end());
+        elseStmts.insert(elseStmts.end(), stmts.begin() + i + 1, stmts.end());
+        BlockNode* thenB = lowerReturns(thenStmts);
+        BlockNode* elseB = thenB ? lowerReturns(elseStmts) : nullptr;
+        if (!elseB) {
+            delete thenB;
+            delete out;
+            return nullptr;
+        }
+        out->statements.push_back(new IfNode(iff->condition, thenB, elseB));
+        return out;
+    }
+    return out;
+}
+
+void decideInline(InlinedCallNode* ic, Environment* env) {
+    ic->decided = true;
+    FuncCallNode* fc = ic->call;
+    if (redefinedFunctions.count(fc->name)) return;
+    Environment* global = env->root();
+    auto it = global->functions.find(fc->name);
+    if (it == global->functions.end()) return;
+    FuncDefNode* func = it->second;
+    if (func->params.size() != fc->args.size()) return;
+
+    // a deferred body with a syntax error keeps reporting it from the real call
+    ASTNode* body;
+    try {
+        body = Parser::parseFuncBody(func);
+    } catch (std::exception&) {
+        return;
+    }
+    int cost = inlineCost(body, func->params);
+    if (cost < 0 || cost > InlineMaxCost) return;
+
+    // '$' can't appear in identifiers, so these never clash with script names
+    static int counter = 0;
+    int id = ++counter;
+    Renames renames;
+    for (auto& p : func->params) {
+        std::string local = "$" + func->name + "." + p + "#" + std::to_string(id);
+        renames[p] = local;
+        ic->locals.push_back(local);
+    }
+
+    // turn returns into the body's value so no exception is thrown; a
+    // body that's just 'return expr' is inlined as expr
+    ASTNode* inlined = cloneRenamed(body, renames);
+    std::vector<ASTNode*> stmts;
+    flatten(inlined, stmts);
+    BlockNode* lowered = lowerReturns(stmts);
+    if (!lowered) {
+        ic->body = inlined;
+        ic->catchesReturn = true;
+    } else if (lowered->statements.size() == 1 && dynamic_cast<ExprStmtNode*>(lowered->statements[0])) {
+        ic->body = static_cast<ExprStmtNode*>(lowered->statements[0])->expr;
+    } else {
+        ic->body = lowered;
+    }
+
+    ic->callee = func;
+    inlinedCalls[fc->name].insert(ic);
+}
+
+static ASTNode* rewrite(ASTNode* node, std::vector<InlinedCallNode*>* sites) {
+    if (!node) return nullptr;
+    if (auto b = dynamic_cast<BinaryOpNode*>(node)) {
+        b->left = rewrite(b->left, sites);
+        b->right = rewrite(b->right, sites);
+        return b;
+    }
+    if (auto a = dynamic_cast<AssignNode*>(node)) {
+        a->value = rewrite(a->value, sites);
+        return a;
+    }
+    if (auto es = dynamic_cast<ExprStmtNode*>(node)) {
+        es->expr = rewrite(es->expr, sites);
+        return es;
+    }
+    if (auto blk = dynamic_cast<BlockNode*>(node)) {
+        for (auto& stmt : blk->statements) stmt = rewrite(stmt, sites);
+        return blk;
+    }
+    if (auto iff = dynamic_cast<IfNode*>(node)) {
+        iff->condition = rewrite(iff->condition, sites);
+        iff->thenBlock = rewrite(iff->thenBlock, sites);
+        iff->elseBlock = rewrite(iff->elseBlock, sites);
+        return iff;
+    }
+    if (auto wh = dynamic_cast<WhileNode*>(node)) {
+        wh->condition = rewrite(wh->condition, sites);
+        wh->body = rewrite(wh->body, sites);
+        return wh;
+    }
+    if (auto fr = dynamic_cast<ForNode*>(node)) {
+        fr->init = rewrite(fr->init, sites);
+        fr->condition = rewrite(fr->condition, sites);
+        fr->update = rewrite(fr->update, sites);
+        fr->body = rewrite(fr->body, sites);
+        return fr;
+    }
+    if (auto fc = dynamic_cast<FuncCallNode*>(node)) {
+        for (auto& arg : fc->args) arg = rewrite(arg, sites);
+        if (fc->name == "print" || redefinedFunctions.count(fc->name)) return fc;
+        InlinedCallNode* ic = new InlinedCallNode(fc);
+        if (sites) sites->push_back(ic);
+        return ic;
+    }
+    if (auto ret = dynamic_cast<ReturnNode*>(node)) {
+        ret->value = rewrite(ret->value, sites);
+        return ret;
+    }
+    // numbers, identifiers, function definitions, already inlined calls
+    return node;
+}
+
+ASTNode* inlineCalls(ASTNode* node, std::vector<InlinedCallNode*>* sites) {
+    return rewrite(node, sites);
+}
+
+void releaseCalls(const std::vector<InlinedCallNode*>& sites) {
+    for (auto ic : sites) {
+        ic->decided = true;
+        if (!ic->callee) continue;
+        ic->callee = nullptr;
+        auto it = inlinedCalls.find(ic->call->name);
+        if (it == inlinedCalls.end()) continue;
+        it->second.erase(ic);
+        if (it->second.empty()) inlinedCalls.erase(it);
+    }
+}
+
+void deoptimizeCalls(const std::string& name) {
+    redefinedFunctions.insert(name);
+    auto it = inlinedCalls.find(name);
+    if (it == inlinedCalls.end()) return;
+    for (auto call : it->second) call->callee = nullptr;
+    inlinedCalls.erase(it);
+}
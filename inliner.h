@@ -0,0 +1,26 @@
+#ifndef INLINER_H
+#define INLINER_H
+
+#include "ast.h"
+#include "environment.h"
+#include <vector>
+
+// Wrap the call sites in node so small, call-free global functions can be
+// inlined there. Doesn't descend into function definitions; their bodies
+// are handled on first call. Returns the (possibly replaced) node.
+// The wrapped sites are appended to sites if given.
+ASTNode* inlineCalls(ASTNode* node, std::vector<InlinedCallNode*>* sites = nullptr);
+
+// Forget call sites whose program or function body is done so they aren't
+// kept for deoptimization; if they run again they make real calls.
+void releaseCalls(const std::vector<InlinedCallNode*>& sites);
+
+// Decide whether to inline a call site; done the first time it runs so only
+// executed calls force a deferred callee body to be parsed.
+void decideInline(InlinedCallNode* ic, Environment* env);
+
+// Called when name is redefined or defined outside the global scope:
+// its inlined call sites fall back to real calls and it's never inlined again.
+void deoptimizeCalls(const std::string& name);
+
+#endif
@@ -2,13 +2,31 @@
 #include <cctype>
 #include <stdexcept>
 
-Lexer::Lexer(const std::string& src) : text(src), pos(0) {
-    currentChar = pos < text.size() ? text[pos] : '\0';
+Lexer::Lexer(const std::string& src)
+    : text(std::make_shared<const std::string>(src)), pos(0), end(src.size()) {
+    currentChar = pos < end ? (*text)[pos] : '\0';
+}
+
+Lexer::Lexer(std::shared_ptr<const std::string> src, size_t begin, size_t end)
+    : text(std::move(src)), pos(begin), end(end) {
+    if (this->end > text->size()) this->end = text->size();
+    currentChar = pos < this->end ? (*text)[pos] : '\0';
 }
 
 void Lexer::advance() {
     pos++;
-    currentChar = pos < text.size() ? text[pos] : '\0';
+    currentChar = pos < end ? (*text)[pos] : '\0';
+}
+
+size_t Lexer::skipBraces() {
+    size_t start = pos;
+    int depth = 1;
+    while (currentChar != '\0') {
+        if (currentChar == '{') depth++;
+        else if (currentChar == '}' && --depth == 0) { advance(); return pos; }
+        advance();
+    }
+    throw std::runtime_error("Parse error: unterminated block starting at position " + std::to_string(start - 1));
 }
 
 void Lexer::skipWhitespace() {
@@ -16,68 +34,80 @@ void Lexer::skipWhitespace() {
 }
 
 Token Lexer::number() {
+    size_t start = pos;
     std::string result;
     while (currentChar != '\0' && isdigit(static_cast<unsigned char>(currentChar))) {
         result += currentChar;
         advance();
     }
-    return {TokenType::Number, result};
+    // fractional part makes it a real literal; otherwise it's an integer
+    if (currentChar == '.') {
+        result += currentChar;
+        advance();
+        while (currentChar != '\0' && isdigit(static_cast<unsigned char>(currentChar))) {
+            result += currentChar;
+            advance();
+        }
+    }
+    return {TokenType::Number, result, start};
 }
 
 Token Lexer::identifier() {
+    size_t start = pos;
     std::string result;
     while (currentChar != '\0' && (isalnum(static_cast<unsigned char>(currentChar)) || currentChar == '_')) {
         result += currentChar;
         advance();
     }
-    if (result == "if") return {TokenType::If, result};
-    if (result == "else") return {TokenType::Else, result};
-    if (result == "while") return {TokenType::While, result};
-    if (result == "for") return {TokenType::For, result};
-    if (result == "func") return {TokenType::Func, result};
-    if (result == "return") return {TokenType::Return, result};
-    return {TokenType::Identifier, result};
+    if (result == "if") return {TokenType::If, result, start};
+    if (result == "else") return {TokenType::Else, result, start};
+    if (result == "while") return {TokenType::While, result, start};
+    if (result == "for") return {TokenType::For, result, start};
+    if (result == "func") return {TokenType::Func, result, start};
+    if (result == "return") return {TokenType::Return, result, start};
+    return {TokenType::Identifier, result, start};
 }
 
 Token Lexer::getNextToken() {
     while (currentChar != '\0') {
         if (isspace(static_cast<unsigned char>(currentChar))) { skipWhitespace(); continue; }
 
+        size_t start = pos;
         if (isdigit(static_cast<unsigned char>(currentChar))) return number();
         if (isalpha(static_cast<unsigned char>(currentChar)) || currentChar == '_') return identifier();
 
-        if (currentChar == '+') { advance(); return {TokenType::Plus, "+"}; }
-        if (currentChar == '-') { advance(); return {TokenType::Minus, "-"}; }
-        if (currentChar == '*') { advance(); return {TokenType::Mul, "*"}; }
-        if (currentChar == '/') { advance(); return {TokenType::Div, "/"}; }
+        if (currentChar == '+') { advance(); return {TokenType::Plus, "+", start}; }
+        if (currentChar == '-') { advance(); return {TokenType::Minus, "-", start}; }
+        if (currentChar == '*') { advance(); return {TokenType::Mul, "*", start}; }
+        if (currentChar == '/') { advance(); return {TokenType::Div, "/", start}; }
         if (currentChar == '=') {
             advance();
-            if (currentChar == '=') { advance(); return {TokenType::Eq, "=="}; }
-            return {TokenType::Assign, "="};
+            if (currentChar == '=') { advance(); return {TokenType::Eq, "==", start}; }
+            return {TokenType::Assign, "=", start};
         }
-        if (currentChar == ';') { advance(); return {TokenType::Semicolon, ";"}; }
-        if (currentChar == '(') { advance(); return {TokenType::LParen, "("}; }
-        if (currentChar == ')') { advance(); return {TokenType::RParen, ")"}; }
-        if (currentChar == '{') { advance(); return {TokenType::LBrace, "{"}; }
-        if (currentChar == '}') { advance(); return {TokenType::RBrace, "}"}; }
-        if (currentChar == ',') { advance(); return {TokenType::Comma, ","}; }
+        if (currentChar == ';') { advance(); return {TokenType::Semicolon, ";", start}; }
+        if (currentChar == '(') { advance(); return {TokenType::LParen, "(", start}; }
+        if (currentChar == ')') { advance(); return {TokenType::RParen, ")", start}; }
+        if (currentChar == '{') { advance(); return {TokenType::LBrace, "{", start}; }
+        if (currentChar == '}') { advance(); return {TokenType::RBrace, "}", start}; }
+        if (currentChar == ',') { advance(); return {TokenType::Comma, ",", start}; }
         if (currentChar == '<') {
             advance();
-            if (currentChar == '=') { advance(); return {TokenType::LessEq, "<="}; }
-            return {TokenType::Less, "<"};
+            if (currentChar == '=') { advance(); return {TokenType::LessEq, "<=", start}; }
+            return {TokenType::Less, "<", start};
         }
         if (currentChar == '>') {
             advance();
-            if (currentChar == '=') { advance(); return {TokenType::GreaterEq, ">="}; }
-            return {TokenType::Greater, ">"};
+            if (currentChar == '=') { advance(); return {TokenType::GreaterEq, ">=", start}; }
+            return {TokenType::Greater, ">", start};
         }
         if (currentChar == '!') {
             advance();
-            if (currentChar == '=') { advance(); return {TokenType::NotEq, "!="}; }
-            throw std::runtime_error("Unexpected '!'");
+            if (currentChar == '=') { advance(); return {TokenType::NotEq, "!=", start}; }
+            throw std::runtime_error("Unexpected '!' at position " + std::to_string(start));
         }
 
-        throw std::runtime_error("Unknown character: " + std::string(1, currentChar));
+        throw std::runtime_error("Unknown character: " + std::string(1, currentChar) + " at position " + std::to_string(start));
     }
-    return {TokenType::EndOfFile, ""};
+    return {TokenType::EndOfFile, "", pos};
 }
@@ -2,6 +2,7 @@
 #define LEXER_H
 
 #include <string>
+#include <memory>
 
 enum class TokenType {
     Number, Identifier,
@@ -18,15 +19,22 @@ enum class TokenType {
 struct Token {
     TokenType type;
     std::string value;
+    size_t pos = 0; // offset of the token in the source
 };
 
 class Lexer {
-    std::string text;
+    std::shared_ptr<const std::string> text;
     size_t pos;
+    size_t end;
     char currentChar;
 public:
     Lexer(const std::string& src);
+    // Lex only [begin, end) of a shared source; positions stay absolute.
+    Lexer(std::shared_ptr<const std::string> src, size_t begin, size_t end);
     Token getNextToken();
+    // Skip to just past the '}' matching an already consumed '{'.
+    size_t skipBraces();
+    std::shared_ptr<const std::string> source() const { return text; }
 private:
     void advance();
     void skipWhitespace();
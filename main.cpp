@@ -5,6 +5,7 @@
 #include "ast.h"
 #include "environment.h"
 #include "evaluator.h"
+#include "inliner.h"
 
 int main() {
     Environment globalEnv;
@@ -15,16 +16,19 @@ int main() {
         std::getline(std::cin, line);
         if (line == "exit") break;
 
+        std::vector<InlinedCallNode*> sites;
         try {
             Lexer lexer(line);
-            Parser parser(lexer);
+            Parser parser(lexer, true);
             ASTNode* program = parser.parseProgram();
-            double result = evaluate(program, &globalEnv);
+            program = inlineCalls(program, &sites);
+            Value result = evaluate(program, &globalEnv);
 
             std::cout << result << std::endl;
         } catch (std::exception& e) {
             std::cout << "Error: " << e.what() << std::endl;
         }
+        releaseCalls(sites);
     }
 
     return 0;
@@ -1,7 +1,7 @@
 #include "parser.h"
 #include <stdexcept>
 
-Parser::Parser(Lexer& lexer) : lexer(lexer) {
+Parser::Parser(Lexer& lexer, bool lazyFunctions) : lexer(lexer), lazyFunctions(lazyFunctions) {
     cur = this->lexer.getNextToken();
 }
 
@@ -10,10 +10,14 @@ void Parser::advance() {
 }
 
 void Parser::expect(TokenType t, const std::string& msg) {
-    if (cur.type != t) throw std::runtime_error("Parse error: " + msg + " (got '" + cur.value + "')");
+    if (cur.type != t) error(msg);
     advance();
 }
 
+void Parser::error(const std::string& msg) {
+    throw std::runtime_error("Parse error: " + msg + " (got '" + cur.value + "') at position " + std::to_string(cur.pos));
+}
+
 ASTNode* Parser::parseProgram() {
     BlockNode* root = new BlockNode();
     while (cur.type != TokenType::EndOfFile) {
@@ -87,22 +91,50 @@ ASTNode* Parser::parseFor() {
 
 ASTNode* Parser::parseFuncDef() {
     expect(TokenType::Func, "expected func");
-    if (cur.type != TokenType::Identifier) throw std::runtime_error("expected function name");
+    if (cur.type != TokenType::Identifier) error("expected function name");
     std::string name = cur.value; advance();
     expect(TokenType::LParen, "expected '(' after func name");
     std::vector<std::string> params;
     if (cur.type != TokenType::RParen) {
-        if (cur.type != TokenType::Identifier) throw std::runtime_error("expected parameter name");
+        if (cur.type != TokenType::Identifier) error("expected parameter name");
         params.push_back(cur.value); advance();
         while (cur.type == TokenType::Comma) {
             advance();
-            if (cur.type != TokenType::Identifier) throw std::runtime_error("expected parameter name");
+            if (cur.type != TokenType::Identifier) error("expected parameter name");
             params.push_back(cur.value); advance();
         }
     }
     expect(TokenType::RParen, "expected ')' after params");
-    ASTNode* body = parseBlock();
-    return new FuncDefNode(name, params, body);
+    if (!lazyFunctions) {
+        ASTNode* body = parseBlock();
+        return new FuncDefNode(name, params, body);
+    }
+
+    // pre-parse: record the body's range and skip it without building an AST
+    if (cur.type != TokenType::LBrace) error("expected '{'");
+    FuncDefNode* fd = new FuncDefNode(name, params, nullptr);
+    fd->source = lexer.source();
+    fd->bodyBegin = cur.pos;
+    fd->bodyEnd = lexer.skipBraces();
+    advance();
+    return fd;
+}
+
+ASTNode* Parser::parseFuncBody(FuncDefNode* func) {
+    if (func->body) return func->body;
+    if (!func->parseError.empty()) throw std::runtime_error(func->parseError);
+    // positions are offsets into the input that defined the function, so name it
+    try {
+        Lexer lexer(func->source, func->bodyBegin, func->bodyEnd);
+        Parser parser(lexer, true);
+        ASTNode* body = parser.parseBlock();
+        if (parser.cur.type != TokenType::EndOfFile) parser.error("unexpected token after function body");
+        func->body = body;
+        return body;
+    } catch (std::exception& e) {
+        func->parseError = "in body of func " + func->name + ": " + e.what();
+        throw std::runtime_error(func->parseError);
+    }
 }
 
 ASTNode* Parser::parseReturn() {
@@ -127,7 +159,7 @@ ASTNode* Parser::parseAssignment() {
             ASTNode* right = parseAssignment();
             return new AssignNode(id->name, right);
         } else {
-            throw std::runtime_error("left side of assignment must be identifier");
+            error("left side of assignment must be identifier");
         }
     }
     return left;
@@ -176,13 +208,22 @@ ASTNode* Parser::parseMultiplicative() {
 
 ASTNode* Parser::parseUnary() {
     if (cur.type == TokenType::Plus) { advance(); return parseUnary(); }
-    if (cur.type == TokenType::Minus) { advance(); ASTNode* r = parseUnary(); return new BinaryOpNode("-", new NumberNode(0), r); }
+    if (cur.type == TokenType::Minus) { advance(); ASTNode* r = parseUnary(); return new BinaryOpNode("-", new NumberNode(Value::fromInt(0)), r); }
     return parsePrimary();
 }
 
 ASTNode* Parser::parsePrimary() {
     if (cur.type == TokenType::Number) {
-        double v = std::stod(cur.value);
+        Value v;
+        if (cur.value.find('.') != std::string::npos) {
+            v = Value::fromDouble(std::stod(cur.value));
+        } else {
+            try {
+                v = Value::number(std::stoll(cur.value));
+            } catch (std::out_of_range&) {
+                v = Value::fromDouble(std::stod(cur.value));
+            }
+        }
         advance();
         return new NumberNode(v);
     }
@@ -207,7 +248,7 @@ ASTNode* Parser::parsePrimary() {
         expect(TokenType::RParen, "expected ')'");
         return e;
     }
-    throw std::runtime_error("unexpected token in primary: " + cur.value);
+    error("unexpected token in primary");
 }
 
 std::vector<ASTNode*> Parser::parseCallArgs() {
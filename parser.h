@@ -6,15 +6,21 @@
 
 class Parser {
 public:
-    Parser(Lexer& lexer);
+    // lazyFunctions: only brace-match function bodies; they are parsed on first call
+    Parser(Lexer& lexer, bool lazyFunctions = false);
     ASTNode* parseProgram();
 
+    // Parse the body of a pre-parsed function if it hasn't been parsed yet
+    static ASTNode* parseFuncBody(FuncDefNode* func);
+
 private:
     Lexer& lexer;
     Token cur;
+    bool lazyFunctions;
 
     void advance();
     void expect(TokenType t, const std::string& msg);
+    [[noreturn]] void error(const std::string& msg);
 
     ASTNode* parseStatement();
     ASTNode* parseBlock();
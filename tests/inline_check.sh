@@ -0,0 +1,37 @@
+#!/bin/sh
+# Compare inlined calls with real calls of the same function body.
+# Each case defines f, calls it (inlined), redefines f with the same
+# body (which deoptimizes it) and calls it again as a real call.
+#
+# usage: tests/inline_check.sh [path/to/interpreter]
+
+interp=${1:-./interpreter}
+status=0
+
+check() {
+    def=$1
+    call=$2
+    # each line echoes its result (0 here) after what print wrote
+    out=$(printf '%s\nprint(%s)\n%s\nprint(%s)\nexit\n' "$def" "$call" "$def" "$call" | "$interp" | sed 's/^\(>>> \)*//')
+    inlined=$(echo "$out" | sed -n 2p)
+    real=$(echo "$out" | sed -n 5p)
+    if [ "$inlined" != "$real" ]; then
+        echo "FAIL: $def; $call: inlined '$inlined', real call '$real'"
+        status=1
+    fi
+}
+
+check 'func f(x) { return x*x; }' 'f(3), f(0-2)'
+check 'func f(x) { if (x < 0) return 0-x; return x; }' 'f(0-4), f(5)'
+check 'func f(x) { if (x > 0) { return 1; } else { if (x < 0) return 0-1; } }' 'f(2), f(0-3), f(0)'
+check 'func f(x) { x = x + 1; }' 'f(4)'
+check 'func f(x) { while (1) { return x; } }' 'f(9)'
+check 'func f(x) { if (x) return; 7; }' 'f(1), f(0)'
+check 'func f(x) { x = x + 5; {} }' 'f(1)'
+check 'func f(x) { if (x) { x = 7; } else { return 3; } {} }' 'f(1), f(0)'
+check 'func f(x) { if (x) {} else { return 3; } }' 'f(1), f(0)'
+check 'func f(x) { { x = x * 2; { } } }' 'f(3)'
+check 'func f(a, b) { a = a - b; return a; }' 'f(10, 4)'
+
+[ $status -eq 0 ] && echo "inline checks passed"
+exit $status
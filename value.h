@@ -0,0 +1,128 @@
+#ifndef VALUE_H
+#define VALUE_H
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <ostream>
+
+// Runtime value: a NaN-boxed 64-bit word.
+//
+// Doubles are stored as their raw IEEE-754 bits (every NaN is canonicalised
+// to a single positive quiet NaN). Integers live in the payload of a negative
+// quiet NaN tagged with 0xFFF9 in the top 16 bits, which leaves 48 bits of
+// signed payload. Integer results that do not fit are promoted to double.
+class Value {
+public:
+    static const int64_t IntMax = (int64_t(1) << 47) - 1;
+    static const int64_t IntMin = -(int64_t(1) << 47);
+
+    Value() : bits(IntTag) {}
+
+    static Value fromInt(int64_t i) {
+        Value v;
+        v.bits = IntTag | (static_cast<uint64_t>(i) & PayloadMask);
+        return v;
+    }
+
+    static Value fromDouble(double d) {
+        Value v;
+        if (d != d) { v.bits = CanonicalNaN; return v; }
+        std::memcpy(&v.bits, &d, sizeof d);
+        return v;
+    }
+
+    // Integer if it fits in the boxed range, double otherwise.
+    static Value number(int64_t i) {
+        if (fitsInt(i)) return fromInt(i);
+        return fromDouble(static_cast<double>(i));
+    }
+
+    static bool fitsInt(int64_t i) { return i >= IntMin && i <= IntMax; }
+
+    bool isInt() const { return (bits & TagMask) == IntTag; }
+    bool isDouble() const { return !isInt(); }
+
+    int64_t asInt() const {
+        // shift the 48-bit payload to the top and back to sign-extend it
+        return static_cast<int64_t>(bits << 16) >> 16;
+    }
+
+    double asDouble() const {
+        double d;
+        std::memcpy(&d, &bits, sizeof d);
+        return d;
+    }
+
+    double toDouble() const { return isInt() ? static_cast<double>(asInt()) : asDouble(); }
+
+    bool isTruthy() const { return isInt() ? asInt() != 0 : asDouble() != 0.0; }
+
+private:
+    static const uint64_t TagMask = 0xFFFF000000000000ULL;
+    static const uint64_t IntTag = 0xFFF9000000000000ULL;
+    static const uint64_t PayloadMask = 0x0000FFFFFFFFFFFFULL;
+    static const uint64_t CanonicalNaN = 0x7FF8000000000000ULL;
+
+    uint64_t bits;
+};
+
+static_assert(sizeof(Value) == sizeof(double), "Value must stay one machine word");
+
+// --- Arithmetic (integer fast path, double fallback)
+inline Value operator+(Value a, Value b) {
+    if (a.isInt() && b.isInt()) return Value::number(a.asInt() + b.asInt());
+    return Value::fromDouble(a.toDouble() + b.toDouble());
+}
+
+inline Value operator-(Value a, Value b) {
+    if (a.isInt() && b.isInt()) return Value::number(a.asInt() - b.asInt());
+    return Value::fromDouble(a.toDouble() - b.toDouble());
+}
+
+inline Value operator*(Value a, Value b) {
+    if (a.isInt() && b.isInt()) {
+        int64_t r;
+        if (!__builtin_mul_overflow(a.asInt(), b.asInt(), &r)) return Value::number(r);
+    }
+    return Value::fromDouble(a.toDouble() * b.toDouble());
+}
+
+// Division keeps the language's real-number semantics: 7/2 is 3.5, but
+// an exact integer quotient stays an integer.
+inline Value operator/(Value a, Value b) {
+    if (a.isInt() && b.isInt() && b.asInt() != 0 && a.asInt() % b.asInt() == 0)
+        return Value::number(a.asInt() / b.asInt());
+    return Value::fromDouble(a.toDouble() / b.toDouble());
+}
+
+// --- Comparisons
+inline bool operator==(Value a, Value b) {
+    if (a.isInt() && b.isInt()) return a.asInt() == b.asInt();
+    return a.toDouble() == b.toDouble();
+}
+
+inline bool operator!=(Value a, Value b) { return !(a == b); }
+
+inline bool operator<(Value a, Value b) {
+    if (a.isInt() && b.isInt()) return a.asInt() < b.asInt();
+    return a.toDouble() < b.toDouble();
+}
+
+inline bool operator>(Value a, Value b) { return b < a; }
+
+inline bool operator<=(Value a, Value b) {
+    if (a.isInt() && b.isInt()) return a.asInt() <= b.asInt();
+    return a.toDouble() <= b.toDouble();
+}
+
+inline bool operator>=(Value a, Value b) { return b <= a; }
+
+inline std::ostream& operator<<(std::ostream& os, Value v) {
+    if (v.isInt()) return os << static_cast<long long>(v.asInt());
+    double d = v.asDouble();
+    if (std::isfinite(d) && std::floor(d) == d && std::fabs(d) < 9.2e18) return os << static_cast<long long>(d);
+    return os << d;
+}
+
+#endif